@@ -12,16 +12,18 @@ typedef int32_t         s32;
 typedef volatile u8     vu8;
 typedef volatile u16    vu16;
 typedef volatile u32    vu32;
-typedef volatile u8     vs8;
-typedef volatile u16    vs16;
-typedef volatile u32    vs32;
+typedef volatile s8     vs8;
+typedef volatile s16    vs16;
+typedef volatile s32    vs32;
 
 typedef u16             Color;
 typedef u32             Tile[8];
 typedef u16             ScreenEntry;
+typedef u16             AffineScreenEntryPair;
 typedef Color           Palbank[16];
 typedef Tile            Charblock[512];
 typedef ScreenEntry     Screenblock[1024];
+typedef AffineScreenEntryPair AffineScreenblock[1024];
 
 typedef struct
 {
@@ -44,6 +46,12 @@ typedef volatile struct
   vu32 control;
 } DmaChannel;
 
+typedef volatile struct
+{
+  vu16 data;
+  vu16 control;
+} TimerChannel;
+
 // BOOLEAN LITERALS
 
 #define false 0
@@ -69,6 +77,7 @@ typedef volatile struct
 #define BG_PALBANKS     ((Palbank*)MEM_PAL)
 #define BG_CHARBLOCKS   ((Charblock*)MEM_VRAM)
 #define BG_SCREENBLOCKS ((Screenblock*)MEM_VRAM)
+#define BG_AFFINE_SCREENBLOCKS ((AffineScreenblock*)MEM_VRAM)
 #define OBJ_PALETTE     ((Color*)MEM_PAL_OBJ)
 #define OBJ_PALBANKS    ((Palbank*)MEM_PAL_OBJ)
 #define OBJ_CHARBLOCKS  ((Charblock*)MEM_VRAM_OBJ)
@@ -80,7 +89,14 @@ typedef volatile struct
 #define REG_VCOUNT       (*(vu16*)(MEM_IO+0x0006))
 #define REG_BGCNT        ((vu16*)(MEM_IO+0x0008))
 #define REG_BGOFS        ((BackgroundScroll*)(MEM_IO+0x0010))
+#define REG_BG2PA        (*(vs16*)(MEM_IO+0x0020))
+#define REG_BG2PB        (*(vs16*)(MEM_IO+0x0022))
+#define REG_BG2PC        (*(vs16*)(MEM_IO+0x0024))
+#define REG_BG2PD        (*(vs16*)(MEM_IO+0x0026))
+#define REG_BG2X         (*(vs32*)(MEM_IO+0x0028))
+#define REG_BG2Y         (*(vs32*)(MEM_IO+0x002C))
 #define REG_DMA          ((DmaChannel*)(MEM_IO+0x00B0))
+#define REG_TM           ((TimerChannel*)(MEM_IO+0x0100))
 #define REG_KEYINPUT     (*(vu16*)(MEM_IO+0x0130))
 #define  REG_SOUNDCNT_L  (*(vu16*)(MEM_IO+0x0080))
 #define  REG_SOUNDCNT_H  (*(vu16*)(MEM_IO+0x0082))
@@ -122,6 +138,10 @@ typedef volatile struct
 #define DMA_32                      0x04000000
 #define DMA_ENABLE                  0x80000000
 
+#define TIMER_PRESCALE_256          0x0002
+#define TIMER_CASCADE               0x0004
+#define TIMER_ENABLE                0x0080
+
 #define KEYINPUT_A                  0x0001
 #define KEYINPUT_B                  0x0002
 #define KEYINPUT_SELECT             0x0004
@@ -191,6 +211,9 @@ typedef volatile struct
 #define SCREEN_ENTRY_ID(n)          ((n)<<0)
 #define SCREEN_ENTRY_PALBANK(n)     ((n)<<12)
 
+// affine entries are bytes but vram ignores byte writes, so write them in pairs
+#define AFFINE_SCREEN_ENTRY_PAIR(a,b) (((a)<<0)|((b)<<8))
+
 #define OBJ_ATTR0_HIDE              0x0200
 #define OBJ_ATTR0_SQUARE            0x0000
 #define OBJ_ATTR0_WIDE              0x4000
@@ -214,6 +237,8 @@ typedef volatile struct
 #define RGB5(r,g,b) (((r)<<0)|((g)<<5)|((b)<<10))
 #define RGB8(r,g,b) (((r)>>3<<0)|((g)>>3<<5)|((b)>>3<<10))
 
+#define FIX8(n)     ((n)*256)
+
 // BIOS CALLS
 
 int Mod(s32 num, s32 den);
@@ -7,6 +7,14 @@
 
 typedef struct { s16 x, y; } MapPosition;
 
+// a difficulty preset, the size of its board and where it sits on screen
+typedef struct
+{
+  s16 width, height;
+  u16 mine_count;
+  s16 origin_x, origin_y; // screen pixel position of the board's top-left
+} BoardPreset;
+
 
 /* VIDEO */
 
@@ -47,6 +55,14 @@ u32 keyHeld(u32 key);
 u32 random();
 
 
+/* DIFFICULTY PRESETS */
+
+// switches to a preset, resets the board and centers it on screen
+// plants the whole minefield so the first click only has to move a few mines
+// also shows the preset's number until the first click
+void selectPreset(const BoardPreset* preset);
+
+
 /* MAP UTILITIES */
 
 // returns a pseudo-random map position, uses the above-declared random function
@@ -62,17 +78,34 @@ ScreenEntry* mapEntryPtr(u32 screenblock, MapPosition position);
 
 /* MINE UTILITIES */
 
-// attempts to plant a mine at a given position, returns whether successful
-u32 plantMine(MapPosition position);
+// plants or removes the mine at a given position and corrects the surrounding
+// counts, returns false if a mine is already planted there
+u32 setMine(MapPosition position, u32 mine);
+
+// returns whether a position lies in the starting area around the reticle
+u32 isStartingArea(MapPosition position, MapPosition reticle_position);
+
+// plants a mine at a random position outside of the starting area
+MapPosition plantRandomMine(MapPosition reticle_position);
 
-// randomizes the minefield
+// fills the map area of the mine screenblock with NO_MINE_TILE_ID
+void mineReset();
+
+// moves a random mine elsewhere, to be run once per idle frame
+void pregenerateMines(MapPosition reticle_position);
+
+// moves the mines in the starting area elsewhere
 // reticle position is needed leave a space for the starting area
-void randomizeMines(MapPosition reticle_position);
+void finalizeMines(MapPosition reticle_position);
+
+// generates an expert minefield that can be solved without guessing
+// uses the seed of the mirrored position in the top-left quarter of the map
+void seedMines(MapPosition reticle_position);
 
 
 /* COVER UTILITIES */
 
-// fills the cover screenblock with a checkered pattern
+// fills the map area of the cover screenblock with a checkered pattern
 void coverReset();
 
 // reveals a given position as well surrounding positions if necessary
@@ -96,6 +129,22 @@ void investigate(MapPosition position);
 void toggleFlag(MapPosition position);
 
 
+/* FRAME TELEMETRY */
+
+// records how many scanlines the finished frame used and whether it overran
+void telemetryRecordFrame();
+
+// restarts the frame timer, to be called as soon as vblank begins
+void telemetryStartFrame();
+
+// toggles the telemetry overlay with select and redraws changed values
+// the redraw uses bios divisions and is counted in the next frame's time
+void updateTelemetryHud();
+
+// draws a 4 digit decimal number on the telemetry overlay, capped at 9999
+void telemetryDrawNumber(u32 n, u32 column);
+
+
 /* MACROS */
 
 // video configuration
@@ -106,11 +155,30 @@ void toggleFlag(MapPosition position);
 #define COVER_SBB        1
 #define SHARED_CBB       0
 #define RETICLE_OBJ      0
+#define TELEMETRY_BG     2
+#define TELEMETRY_SBB    3
+#define TELEMETRY_TIMER  2
+#define PRESET_BG        3
+#define PRESET_SBB       4
+#define PRESET_COLUMN    29
 
 // game configuration
-#define MAP_WIDTH        30
-#define MAP_HEIGHT       20
-#define MINE_COUNT       140
+#define BEGINNER             0
+#define BEGINNER_WIDTH       9
+#define BEGINNER_HEIGHT      9
+#define BEGINNER_MINES       10
+#define INTERMEDIATE         1
+#define INTERMEDIATE_WIDTH   16
+#define INTERMEDIATE_HEIGHT  16
+#define INTERMEDIATE_MINES   40
+#define EXPERT               2
+#define EXPERT_WIDTH         30
+#define EXPERT_HEIGHT        20
+#define EXPERT_MINES         140
+#define PRESET_COUNT         3
+#define MAX_MAP_WIDTH        30
+#define MAX_MAP_HEIGHT       20
+#define MAX_MINE_COUNT       140
 
 // tile id configuration
 #define BLANK_TILE_ID    0
@@ -120,8 +188,18 @@ void toggleFlag(MapPosition position);
 #define COVER_TILE_ID    12
 #define REVEAL_TILE_ID   13
 #define RETICLE_TILE_ID  1
+#define ZERO_TILE_ID     14
+#define NINE_TILE_ID     15
 #define ENTRY_ID_MASK    0x01FF
 
+// frame telemetry configuration, enabled by building with TELEMETRY=1
+#ifndef FRAME_TELEMETRY
+#define FRAME_TELEMETRY  0
+#endif
+#define FRAME_SCANLINES  228
+#define HISTOGRAM_SIZE   8
+#define HUD_VALUE_COUNT  3
+
 
 /* GLOBAL VARIABLES */
 
@@ -129,7 +207,22 @@ u16 keys_current = 0x0000;
 u16 keys_previous = 0x0000;
 u32 rng_value = 0;
 u32 reticle_move_repeat_delay = 8;
-MapPosition reticle_position = { (MAP_WIDTH-1)/2, (MAP_HEIGHT-1)/2 };
+MapPosition reticle_position;
+MapPosition mine_positions[MAX_MINE_COUNT];
+const BoardPreset* board;
+ScreenEntry* flood_cover_entries[MAX_MAP_WIDTH*MAX_MAP_HEIGHT];
+u32 flood_cover_entry_count;
+
+#if FRAME_TELEMETRY
+u32 frame_scanlines = 0;
+u32 frame_scanlines_max = 0;
+u32 frames_dropped = 0;
+u32 telemetry_hud_visible = false;
+u32 telemetry_hud_values[HUD_VALUE_COUNT];
+// bucket n counts frames that used 32n to 32n+31 scanlines, the last bucket
+// also collects every frame that overran
+u32 frame_histogram[HISTOGRAM_SIZE];
+#endif
 
 
 /* GLOBAL CONSTANTS */
@@ -173,41 +266,107 @@ const Palbank BG_COLORS[3] =
 
 const Palbank OBJ_COLORS = { RGB8(0,0,0),RGB8(255, 238, 88),RGB8(0,0,0) };
 
+// rng seeds of no-guess boards, generated by seedsearch
+// regenerate whenever mine placement changes
+const u16 NO_GUESS_SEEDS[10] =
+{
+  0x0434,0x0657,0x00D8,0x0157,0x1071,0x08DF,0x0A37,0x0029,0x0327,0x06CB
+};
+
+// index into NO_GUESS_SEEDS for every start in the top-left quarter
+// two starts per byte, the even column in the low nibble
+const u8 NO_GUESS_SEED_INDICES[EXPERT_HEIGHT/2][(EXPERT_WIDTH/2+1)/2] =
+{
+  { 0x11,0x01,0x00,0x00,0x11,0x11,0x11,0x05 },
+  { 0x11,0x03,0x00,0x00,0x11,0x11,0x11,0x05 },
+  { 0x11,0x31,0x00,0x00,0x00,0x11,0x11,0x05 },
+  { 0x31,0x33,0x00,0x00,0x00,0x56,0x17,0x01 },
+  { 0x11,0x93,0x00,0x00,0x00,0x56,0x22,0x02 },
+  { 0x31,0x00,0x00,0x00,0x00,0x20,0x22,0x02 },
+  { 0x01,0x00,0x00,0x00,0x00,0x10,0x22,0x02 },
+  { 0x08,0x00,0x00,0x00,0x00,0x20,0x22,0x02 },
+  { 0x44,0x04,0x00,0x00,0x20,0x22,0x22,0x02 },
+  { 0x44,0x04,0x00,0x00,0x20,0x22,0x22,0x02 }
+};
+
+#if FRAME_TELEMETRY
+const Tile TELEMETRY_TILES[2] =
+{
+  { 0x00000000,0x00077000,0x00700700,0x00700700,0x00700700,0x00700700,0x00077000,0x00000000 }, // numeral 0
+  { 0x00000000,0x00077000,0x00700700,0x00700700,0x00777000,0x00700000,0x00077000,0x00000000 }  // numeral 9
+};
+#endif
+
+// fills in a preset's dimensions and its centered screen position
+#define BOARD_PRESET(WIDTH, HEIGHT, MINES) \
+  { WIDTH, HEIGHT, MINES, (240-(WIDTH)*8)/2, (160-(HEIGHT)*8)/2 }
+
+const BoardPreset BOARD_PRESETS[PRESET_COUNT] =
+{
+  BOARD_PRESET(BEGINNER_WIDTH, BEGINNER_HEIGHT, BEGINNER_MINES),
+  BOARD_PRESET(INTERMEDIATE_WIDTH, INTERMEDIATE_HEIGHT, INTERMEDIATE_MINES),
+  BOARD_PRESET(EXPERT_WIDTH, EXPERT_HEIGHT, EXPERT_MINES)
+};
+
 
 /* FUNCTION IMPLEMENTATIONS */
 
 void main()
 {
   // setup
-  coverReset();
+  selectPreset(&BOARD_PRESETS[EXPERT]);
   vsync();
   setupVideo();
   setupSound();
 
-  // game loop until user hits A for the first time
+  // title loop until user hits A for the first time
   while(true)
   {
     vsync();
     keyPoll();
+
+    // L and R switch between difficulty presets
+    if (keyHit(KEYINPUT_L) && board > &BOARD_PRESETS[0])
+      selectPreset(board-1);
+    if (keyHit(KEYINPUT_R) && board < &BOARD_PRESETS[PRESET_COUNT-1])
+      selectPreset(board+1);
+
     updateReticle();
+#if FRAME_TELEMETRY
+    updateTelemetryHud();
+#endif
 
     // use users input to add some variation to the rng
     rng_value += REG_KEYINPUT;
 
     if (keyHit(KEYINPUT_A))
     {
-      randomizeMines(reticle_position);
+      finalizeMines(reticle_position);
+      investigate(reticle_position);
+      break;
+    }
+
+    if (keyHit(KEYINPUT_START) && board == &BOARD_PRESETS[EXPERT])
+    {
+      seedMines(reticle_position);
       investigate(reticle_position);
       break;
     }
+
+    pregenerateMines(reticle_position);
   }
 
+  REG_DISPCNT &= ~DISPCNT_BG(PRESET_BG);
+
   // main game loop
   while(true)
   {
     vsync();
     keyPoll();
     updateReticle();
+#if FRAME_TELEMETRY
+    updateTelemetryHud();
+#endif
 
     if (keyHit(KEYINPUT_A))
       investigate(reticle_position);
@@ -234,25 +393,49 @@ void setupVideo()
   REG_DMA[3].destination = OBJ_PALBANKS;
   REG_DMA[3].control = DMA_ENABLE | DMA_32 | DMA_COUNT(sizeof(OBJ_COLORS)/4);
 
+#if FRAME_TELEMETRY
+  REG_DMA[3].source = TELEMETRY_TILES;
+  REG_DMA[3].destination = BG_CHARBLOCKS[SHARED_CBB][ZERO_TILE_ID];
+  REG_DMA[3].control = DMA_ENABLE | DMA_32 | DMA_COUNT(sizeof(TELEMETRY_TILES)/4);
+#endif
+
   OBJ_ATTRIBUTES[RETICLE_OBJ].attr0 = OBJ_ATTR0_HIDE;
   OBJ_ATTRIBUTES[RETICLE_OBJ].attr2 = OBJ_ATTR2_TILE_ID(RETICLE_TILE_ID);
 
   REG_DISPCNT = (
-    DISPCNT_MODE(GFX_MODE) | DISPCNT_BG(COVER_BG) |
-    DISPCNT_BG(MINE_BG) | DISPCNT_OBJ | DISPCNT_OBJ_1D
+    DISPCNT_MODE(GFX_MODE) | DISPCNT_BG(COVER_BG) | DISPCNT_BG(MINE_BG) |
+    DISPCNT_BG(PRESET_BG) | DISPCNT_OBJ | DISPCNT_OBJ_1D
   );
   REG_BGCNT[COVER_BG] = (
-    BGCNT_REG_32x32 | BGCNT_CHARBLOCK(SHARED_CBB) | BGCNT_SCREENBLOCK(COVER_SBB)
+    BGCNT_REG_32x32 | BGCNT_CHARBLOCK(SHARED_CBB) |
+    BGCNT_SCREENBLOCK(COVER_SBB) | BGCNT_PRIORITY(1)
   );
   REG_BGCNT[MINE_BG] = (
-    BGCNT_REG_32x32 | BGCNT_CHARBLOCK(SHARED_CBB) | BGCNT_SCREENBLOCK(MINE_SBB)
+    BGCNT_REG_32x32 | BGCNT_CHARBLOCK(SHARED_CBB) |
+    BGCNT_SCREENBLOCK(MINE_SBB) | BGCNT_PRIORITY(1)
   );
+  REG_BGCNT[PRESET_BG] = (
+    BGCNT_REG_32x32 | BGCNT_CHARBLOCK(SHARED_CBB) |
+    BGCNT_SCREENBLOCK(PRESET_SBB) | BGCNT_PRIORITY(0)
+  );
+#if FRAME_TELEMETRY
+  REG_BGCNT[TELEMETRY_BG] = (
+    BGCNT_REG_32x32 | BGCNT_CHARBLOCK(SHARED_CBB) |
+    BGCNT_SCREENBLOCK(TELEMETRY_SBB) | BGCNT_PRIORITY(0)
+  );
+#endif
 }
 
 void vsync()
 {
+#if FRAME_TELEMETRY
+  telemetryRecordFrame();
+#endif
   while(REG_VCOUNT >= 160);
   while(REG_VCOUNT < 160);
+#if FRAME_TELEMETRY
+  telemetryStartFrame();
+#endif
 }
 
 void setupSound()
@@ -296,6 +479,43 @@ void boom()
   );
 }
 
+void selectPreset(const BoardPreset* preset)
+{
+  board = preset;
+
+  // clear the cover, mine, telemetry and preset screenblocks, which are
+  // adjacent in vram, nothing else clears them after power-on
+  volatile u32 source_data = 0;
+  u32 words = 4*sizeof(Screenblock)/4;
+  REG_DMA[3].source = &source_data;
+  REG_DMA[3].destination = BG_SCREENBLOCKS[COVER_SBB];
+  REG_DMA[3].control = DMA_ENABLE | DMA_32 | DMA_SRC_FIXED | DMA_COUNT(words);
+
+  coverReset();
+  mineReset();
+  reticle_position.x = (board->width-1)/2;
+  reticle_position.y = (board->height-1)/2;
+  for (u32 i = 0; i < board->mine_count; i++)
+    mine_positions[i] = plantRandomMine(reticle_position);
+
+  REG_BGOFS[COVER_BG].x = -board->origin_x;
+  REG_BGOFS[COVER_BG].y = -board->origin_y;
+  REG_BGOFS[MINE_BG].x = -board->origin_x;
+  REG_BGOFS[MINE_BG].y = -board->origin_y;
+
+#if FRAME_TELEMETRY
+  // the overlay was cleared above, draw every value again
+  for (u32 i = 0; i < HUD_VALUE_COUNT; i++)
+    telemetry_hud_values[i] = -1;
+#endif
+
+  // numerals 1 to 3 follow the dot tile
+  // the expert board fills the screen, so there the number sits on top of
+  // the board's top-right cell until the first click
+  u32 preset_number = board - BOARD_PRESETS + 1;
+  BG_SCREENBLOCKS[PRESET_SBB][PRESET_COLUMN] = NO_MINE_TILE_ID + preset_number;
+}
+
 void keyPoll()
 {
   keys_previous = keys_current;
@@ -320,18 +540,19 @@ u32 random()
 
 MapPosition randomMapPosition()
 {
+  // scale each half of r by a multiply instead of two bios divisions
   MapPosition position;
   u32 r = random();
-  position.x = Mod(r & 0xFFFF, MAP_WIDTH);
-  position.y = Mod(r >> 16, MAP_HEIGHT);
+  position.x = ((r & 0xFFFF) * board->width) >> 16;
+  position.y = ((r >> 16) * board->height) >> 16;
   return position;
 }
 
 u32 mapPositionIsValid(MapPosition position)
 {
   return (
-    0 <= position.x && position.x < MAP_WIDTH &&
-    0 <= position.y && position.y < MAP_HEIGHT
+    0 <= position.x && position.x < board->width &&
+    0 <= position.y && position.y < board->height
   );
 }
 
@@ -341,13 +562,13 @@ ScreenEntry* mapEntryPtr(u32 screenblock, MapPosition position)
   return &BG_SCREENBLOCKS[screenblock][index];
 }
 
-u32 plantMine(MapPosition position)
+u32 setMine(MapPosition position, u32 mine)
 {
   ScreenEntry* entry = mapEntryPtr(MINE_SBB, position);
-  if (*entry == MINE_TILE_ID)
+  if (mine && *entry == MINE_TILE_ID)
     return false;
   else
-    *entry = MINE_TILE_ID;
+    *entry = mine ? MINE_TILE_ID : NO_MINE_TILE_ID;
 
   for (s32 offset_x = -1; offset_x <= 1; offset_x++)
     for (s32 offset_y = -1; offset_y <= 1; offset_y++)
@@ -361,46 +582,88 @@ u32 plantMine(MapPosition position)
           continue;
         ScreenEntry* adjacent_entry = mapEntryPtr(MINE_SBB, adjacent_position);
         if (*adjacent_entry != MINE_TILE_ID)
-          (*adjacent_entry) += 1;
+          (*adjacent_entry) += mine ? 1 : -1;
+        else if (!mine)
+          (*entry) += 1;
       }
-  
+
   return true;
 }
 
-void randomizeMines(MapPosition reticle_position)
+u32 isStartingArea(MapPosition position, MapPosition reticle_position)
 {
-  // fill minefield with NO_MINE_TILE_ID
-  volatile ScreenEntry source_data[2] = { NO_MINE_TILE_ID, NO_MINE_TILE_ID };
-  u32 words = sizeof(Screenblock)/4; 
-  REG_DMA[3].source = source_data;
-  REG_DMA[3].destination = BG_SCREENBLOCKS[MINE_SBB];
-  REG_DISPCNT |= DISPCNT_BLANK;
-  REG_DMA[3].control = DMA_ENABLE | DMA_32 | DMA_SRC_FIXED | DMA_COUNT(words);
-  REG_DISPCNT &= ~DISPCNT_BLANK;
+  s32 dx = position.x - reticle_position.x;
+  s32 dy = position.y - reticle_position.y;
+  return !((dx/4 || dy/2) && (dx/2 || dy/4));
+}
+
+MapPosition plantRandomMine(MapPosition reticle_position)
+{
+  MapPosition mine_pos;
+  do
+    mine_pos = randomMapPosition();
+  while (isStartingArea(mine_pos, reticle_position) || !setMine(mine_pos, true));
+  return mine_pos;
+}
+
+void mineReset()
+{
+  MapPosition pos;
+  for (pos.x = 0; pos.x < board->width; pos.x++)
+    for (pos.y = 0; pos.y < board->height; pos.y++)
+      *mapEntryPtr(MINE_SBB, pos) = NO_MINE_TILE_ID;
+}
+
+void pregenerateMines(MapPosition reticle_position)
+{
+  // keep moving mines around so the board still depends on input timing
+  u32 i = Mod(random() & 0xFFFF, board->mine_count);
+  setMine(mine_positions[i], false);
+  mine_positions[i] = plantRandomMine(reticle_position);
+}
 
-  // place mines
-  for (u32 i = 0; i < MINE_COUNT; i++)
+void finalizeMines(MapPosition reticle_position)
+{
+  // the reticle may have moved since these mines were planted
+  // the starting area holds at most 33 cells, which bounds the work here
+  for (u32 i = 0; i < board->mine_count; i++)
+    if (isStartingArea(mine_positions[i], reticle_position))
+    {
+      setMine(mine_positions[i], false);
+      mine_positions[i] = plantRandomMine(reticle_position);
+    }
+}
+
+void seedMines(MapPosition reticle_position)
+{
+  u32 flip_x = reticle_position.x >= EXPERT_WIDTH/2;
+  u32 flip_y = reticle_position.y >= EXPERT_HEIGHT/2;
+  s32 start_x = flip_x ? EXPERT_WIDTH-1 - reticle_position.x : reticle_position.x;
+  s32 start_y = flip_y ? EXPERT_HEIGHT-1 - reticle_position.y : reticle_position.y;
+
+  mineReset();
+  u32 seed_index = NO_GUESS_SEED_INDICES[start_y][start_x/2] >> (start_x%2*4) & 0xF;
+  rng_value = NO_GUESS_SEEDS[seed_index];
+
+  for (u32 i = 0; i < EXPERT_MINES; i++)
   {
     MapPosition mine_pos;
-    u32 plant_succesful = 0;
     do
     {
       mine_pos = randomMapPosition();
-
-      s32 dx = mine_pos.x - reticle_position.x;
-      s32 dy = mine_pos.y - reticle_position.y;
-      if (!((dx/4 || dy/2) && (dx/2 || dy/4)))
-        continue;
-      plant_succesful = plantMine(mine_pos);
-    } while (!plant_succesful); 
+      if (flip_x)
+        mine_pos.x = EXPERT_WIDTH-1 - mine_pos.x;
+      if (flip_y)
+        mine_pos.y = EXPERT_HEIGHT-1 - mine_pos.y;
+    } while (isStartingArea(mine_pos, reticle_position) || !setMine(mine_pos, true));
   }
 }
 
 void coverReset()
 {
   MapPosition pos;
-  for (pos.x = 0; pos.x < MAP_WIDTH; pos.x++)
-    for (pos.y = 0; pos.y < MAP_HEIGHT; pos.y++)
+  for (pos.x = 0; pos.x < board->width; pos.x++)
+    for (pos.y = 0; pos.y < board->height; pos.y++)
     {
       ScreenEntry* entry = mapEntryPtr(COVER_SBB, pos);
       u32 palbank = ((pos.x + pos.y) & 1) + 1;
@@ -408,9 +671,6 @@ void coverReset()
     }
 }
 
-ScreenEntry* flood_cover_entries[MAP_WIDTH*MAP_HEIGHT];
-u32 flood_cover_entry_count;
-
 void coverReveal(MapPosition position)
 {
   Tile* reveal_tile = &BG_CHARBLOCKS[SHARED_CBB][COVER_TILE_ID+1];
@@ -473,11 +733,11 @@ void updateReticle()
     reticle_move_repeat_delay = 16;
     if (keyHit(KEYINPUT_LEFT) && reticle_position.x > 0)
       reticle_position.x -= 1;
-    if (keyHit(KEYINPUT_RIGHT) && reticle_position.x < MAP_WIDTH-1)
+    if (keyHit(KEYINPUT_RIGHT) && reticle_position.x < board->width-1)
       reticle_position.x += 1;
     if (keyHit(KEYINPUT_UP) && reticle_position.y > 0)
       reticle_position.y -= 1;
-    if (keyHit(KEYINPUT_DOWN) && reticle_position.y < MAP_HEIGHT-1)
+    if (keyHit(KEYINPUT_DOWN) && reticle_position.y < board->height-1)
       reticle_position.y += 1;
   }
 
@@ -488,18 +748,18 @@ void updateReticle()
     reticle_move_repeat_delay = 4;
     if (keyHeld(KEYINPUT_LEFT) && reticle_position.x > 0)
       reticle_position.x -= 1;
-    if (keyHeld(KEYINPUT_RIGHT) && reticle_position.x < MAP_WIDTH-1)
+    if (keyHeld(KEYINPUT_RIGHT) && reticle_position.x < board->width-1)
       reticle_position.x += 1;
     if (keyHeld(KEYINPUT_UP) && reticle_position.y > 0)
       reticle_position.y -= 1;
-    if (keyHeld(KEYINPUT_DOWN) && reticle_position.y < MAP_HEIGHT-1)
+    if (keyHeld(KEYINPUT_DOWN) && reticle_position.y < board->height-1)
       reticle_position.y += 1;
   }
   
   ObjectAttributes* attributes = &OBJ_ATTRIBUTES[RETICLE_OBJ];
 
-  s32 pixel_x = reticle_position.x * 8 - 4;
-  s32 pixel_y = reticle_position.y * 8 - 4;
+  s32 pixel_x = board->origin_x + reticle_position.x * 8 - 4;
+  s32 pixel_y = board->origin_y + reticle_position.y * 8 - 4;
 
   attributes->attr0 = OBJ_ATTR0_Y(pixel_y) | OBJ_ATTR0_SQUARE;
   attributes->attr1 = OBJ_ATTR1_X(pixel_x) | OBJ_ATTR1_SIZE_16;
@@ -535,4 +795,84 @@ void toggleFlag(MapPosition position)
     *cover_entry = *cover_entry & ~ENTRY_ID_MASK | FLAG_TILE_ID;
   else if ((*cover_entry & ENTRY_ID_MASK) == FLAG_TILE_ID)
     *cover_entry = *cover_entry & ~ENTRY_ID_MASK | COVER_TILE_ID;
-}
\ No newline at end of file
+}
+
+#if FRAME_TELEMETRY
+
+void telemetryRecordFrame()
+{
+  // the timer ticks every 256 cycles and a scanline takes 1232 cycles
+  // polling vcount alone could not tell a fast frame from one a frame late
+  // the next timer counts overflows, reread the pair if one happens mid-read
+  u32 overflows, ticks;
+  do
+  {
+    overflows = REG_TM[TELEMETRY_TIMER+1].data;
+    ticks = overflows << 16 | REG_TM[TELEMETRY_TIMER].data;
+  } while (overflows != REG_TM[TELEMETRY_TIMER+1].data);
+
+  // clamp to keep ticks * 16 positive, about half an hour of frame time
+  if (ticks > 0x07FFFFFF)
+    ticks = 0x07FFFFFF;
+  u32 scanlines = Div(ticks * 16, 77);
+
+  frame_scanlines = scanlines;
+  if (scanlines > frame_scanlines_max)
+    frame_scanlines_max = scanlines;
+  frames_dropped += Div(scanlines, FRAME_SCANLINES);
+
+  u32 bucket = scanlines >> 5;
+  frame_histogram[bucket < HISTOGRAM_SIZE ? bucket : HISTOGRAM_SIZE-1]++;
+}
+
+void telemetryStartFrame()
+{
+  REG_TM[TELEMETRY_TIMER].control = 0;
+  REG_TM[TELEMETRY_TIMER+1].control = 0;
+  REG_TM[TELEMETRY_TIMER+1].control = TIMER_ENABLE | TIMER_CASCADE;
+  REG_TM[TELEMETRY_TIMER].control = TIMER_ENABLE | TIMER_PRESCALE_256;
+}
+
+void updateTelemetryHud()
+{
+  if (keyHit(KEYINPUT_SELECT))
+  {
+    telemetry_hud_visible = !telemetry_hud_visible;
+    REG_DISPCNT ^= DISPCNT_BG(TELEMETRY_BG);
+    for (u32 i = 0; i < HUD_VALUE_COUNT; i++)
+      telemetry_hud_values[i] = -1;
+  }
+
+  if (!telemetry_hud_visible)
+    return;
+
+  u32 values[HUD_VALUE_COUNT] = { frame_scanlines, frame_scanlines_max, frames_dropped };
+  for (u32 i = 0; i < HUD_VALUE_COUNT; i++)
+    if (values[i] != telemetry_hud_values[i])
+    {
+      telemetry_hud_values[i] = values[i];
+      telemetryDrawNumber(values[i], i * 5);
+    }
+}
+
+void telemetryDrawNumber(u32 n, u32 column)
+{
+  if (n > 9999)
+    n = 9999;
+
+  for (u32 i = 0; i < 4; i++)
+  {
+    u32 digit = Mod(n, 10);
+    n = Div(n, 10);
+
+    ScreenEntry* entry = &BG_SCREENBLOCKS[TELEMETRY_SBB][column + 3 - i];
+    if (digit == 0)
+      *entry = ZERO_TILE_ID;
+    else if (digit == 9)
+      *entry = NINE_TILE_ID;
+    else
+      *entry = NO_MINE_TILE_ID + digit;
+  }
+}
+
+#endif
@@ -0,0 +1,562 @@
+/* (c) 2019 Lucas Towers - Licensed under MIT */
+
+// Host tool that searches for minesweeper seeds whose boards can be solved
+// without guessing, and prints them as the NO_GUESS_SEEDS tables.
+//
+// Boards are generated exactly like seedMines in minesweeper.c does for an
+// expert first click in the top-left quarter of the map. The ROM mirrors the board
+// for clicks in the other quarters, so only those clicks are searched.
+//
+// The first pass finds the lowest solvable seed of every start, which bounds
+// the seeds worth considering. The second pass checks every seed below that
+// bound against every start, then a short list of seeds covering all starts
+// is picked greedily so the ROM only stores a 4 bit index per start.
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/* MACROS */
+
+// must match the expert preset in minesweeper.c
+#define MAP_WIDTH        30
+#define MAP_HEIGHT       20
+#define MINE_COUNT       140
+
+#define MAP_CELLS        (MAP_WIDTH*MAP_HEIGHT)
+#define START_WIDTH      (MAP_WIDTH/2)
+#define START_HEIGHT     (MAP_HEIGHT/2)
+#define START_COUNT      (START_WIDTH*START_HEIGHT)
+#define START_WORDS      ((START_COUNT+63)/64)
+#define SEED_COUNT       65536
+#define SEED_LIST_SIZE   16
+#define MAX_WORKERS      256
+
+#define false            0
+#define true             1
+
+#define UNKNOWN          0
+#define REVEALED         1
+#define FLAGGED          2
+
+
+/* TYPES */
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef int32_t  s32;
+typedef uint64_t u64;
+
+typedef struct
+{
+  u8 mine[MAP_CELLS];
+  u8 count[MAP_CELLS];
+} Board;
+
+// every worker owns a range of tasks, idle workers steal half of a range
+typedef struct
+{
+  pthread_mutex_t lock;
+  u32 begin;
+  u32 end;
+  u64 boards;
+  u64 solvable;
+  u64 skipped;
+  pthread_t thread;
+} Worker;
+
+
+/* BOARD GENERATION */
+
+// mirrors random in minesweeper.c
+u32 lcgNext(u32* state);
+
+// mirrors isStartingArea in minesweeper.c
+u32 isStartingArea(s32 x, s32 y, s32 start_x, s32 start_y);
+
+// mirrors seedMines in minesweeper.c for an unmirrored click
+void generateBoard(Board* board, u32 seed, s32 start_x, s32 start_y);
+
+
+/* SOLVER */
+
+// collects the unknown neighbours of a cell, returns how many mines they hold
+s32 unknownNeighbours(const Board* board, const u8* state, u32 cell, u32* unknown, u32* unknown_count);
+
+// reveals a cell and floodfills through zeros like coverRevealRecurse does
+// returns how many cells were revealed
+u32 reveal(const Board* board, u8* state, u32 cell);
+
+// returns whether the board can be cleared from the given first click using
+// only single-number and overlapping-pair deductions and the mine count
+u32 solveBoard(const Board* board, s32 start_x, s32 start_y);
+
+
+/* SEED SELECTION */
+
+// picks seeds greedily until every start is covered, fills start_indices
+// returns how many seeds were picked or 0 if more than SEED_LIST_SIZE are needed
+u32 pickSeedList();
+
+
+/* WORK STEALING */
+
+// runs the workers over every start and every seed below seed_limit
+void runPass(const char* name);
+
+// takes a task from the worker's own range or steals from another worker
+u32 takeTask(Worker* self, u32* task);
+
+// worker thread entry point
+void* workerMain(void* argument);
+
+
+/* GLOBAL VARIABLES */
+
+Worker workers[MAX_WORKERS];
+u32 worker_count;
+
+// seeds checked by the current pass are below this
+u32 seed_limit;
+
+// whether the current pass records every solvable seed instead of the lowest
+u32 covering;
+
+// lowest solvable seed found so far for every starting position
+// seeds above it are skipped, which keeps the result independent of threads
+u32 start_seeds[START_COUNT];
+
+// bitset of the starts every seed solves, filled by the covering pass
+u64 seed_starts[SEED_COUNT][START_WORDS];
+
+// picked seeds and the index into them of every starting position
+u32 seed_list[SEED_LIST_SIZE];
+u32 start_indices[START_COUNT];
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+int main(int argc, char** argv)
+{
+  worker_count = argc > 1 ? atoi(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+  if (worker_count < 1)
+    worker_count = 1;
+  if (worker_count > MAX_WORKERS)
+    worker_count = MAX_WORKERS;
+
+  for (u32 i = 0; i < START_COUNT; i++)
+    start_seeds[i] = SEED_COUNT;
+
+  seed_limit = SEED_COUNT;
+  covering = false;
+  runPass("lowest seeds");
+
+  seed_limit = 0;
+  for (u32 start = 0; start < START_COUNT; start++)
+  {
+    if (start_seeds[start] == SEED_COUNT)
+    {
+      fprintf(stderr, "no seed found for start %u,%u\n",
+        start % START_WIDTH, start / START_WIDTH);
+      return 1;
+    }
+    if (start_seeds[start] >= seed_limit)
+      seed_limit = start_seeds[start] + 1;
+  }
+
+  covering = true;
+  runPass("seed cover");
+
+  u32 seed_list_count = pickSeedList();
+  if (!seed_list_count)
+  {
+    fprintf(stderr, "no list of %u seeds covers every start\n", SEED_LIST_SIZE);
+    return 1;
+  }
+
+  printf("const u16 NO_GUESS_SEEDS[%u] =\n{\n  ", seed_list_count);
+  for (u32 i = 0; i < seed_list_count; i++)
+    printf("0x%04X%s", seed_list[i], i < seed_list_count-1 ? "," : "");
+  printf("\n};\n\n");
+
+  printf("const u8 NO_GUESS_SEED_INDICES[EXPERT_HEIGHT/2][(EXPERT_WIDTH/2+1)/2] =\n{\n");
+  for (u32 y = 0; y < START_HEIGHT; y++)
+  {
+    printf("  { ");
+    for (u32 x = 0; x < START_WIDTH; x += 2)
+    {
+      u32 low = start_indices[y * START_WIDTH + x];
+      u32 high = x+1 < START_WIDTH ? start_indices[y * START_WIDTH + x+1] : 0;
+      printf("0x%X%X%s", high, low, x+2 < START_WIDTH ? "," : "");
+    }
+    printf(" }%s\n", y < START_HEIGHT-1 ? "," : "");
+  }
+  printf("};\n");
+
+  return 0;
+}
+
+u32 lcgNext(u32* state)
+{
+  *state = 1103515245 * *state + 24691;
+  return *state;
+}
+
+u32 isStartingArea(s32 x, s32 y, s32 start_x, s32 start_y)
+{
+  s32 dx = x - start_x;
+  s32 dy = y - start_y;
+  return !((dx/4 || dy/2) && (dx/2 || dy/4));
+}
+
+void generateBoard(Board* board, u32 seed, s32 start_x, s32 start_y)
+{
+  for (u32 i = 0; i < MAP_CELLS; i++)
+  {
+    board->mine[i] = false;
+    board->count[i] = 0;
+  }
+
+  u32 state = seed;
+  for (u32 i = 0; i < MINE_COUNT; i++)
+  {
+    s32 x, y;
+    do
+    {
+      u32 r = lcgNext(&state);
+      x = ((r & 0xFFFF) * MAP_WIDTH) >> 16;
+      y = ((r >> 16) * MAP_HEIGHT) >> 16;
+    } while (isStartingArea(x, y, start_x, start_y) || board->mine[x + y * MAP_WIDTH]);
+
+    board->mine[x + y * MAP_WIDTH] = true;
+    for (s32 offset_x = -1; offset_x <= 1; offset_x++)
+      for (s32 offset_y = -1; offset_y <= 1; offset_y++)
+      {
+        s32 adjacent_x = x + offset_x;
+        s32 adjacent_y = y + offset_y;
+        if ((offset_x || offset_y) && 0 <= adjacent_x && adjacent_x < MAP_WIDTH &&
+            0 <= adjacent_y && adjacent_y < MAP_HEIGHT)
+          board->count[adjacent_x + adjacent_y * MAP_WIDTH]++;
+      }
+  }
+}
+
+s32 unknownNeighbours(const Board* board, const u8* state, u32 cell, u32* unknown, u32* unknown_count)
+{
+  s32 x = cell % MAP_WIDTH;
+  s32 y = cell / MAP_WIDTH;
+  s32 mines = board->count[cell];
+  *unknown_count = 0;
+
+  for (s32 offset_x = -1; offset_x <= 1; offset_x++)
+    for (s32 offset_y = -1; offset_y <= 1; offset_y++)
+    {
+      s32 adjacent_x = x + offset_x;
+      s32 adjacent_y = y + offset_y;
+      if ((offset_x == 0 && offset_y == 0) || adjacent_x < 0 || adjacent_x >= MAP_WIDTH ||
+          adjacent_y < 0 || adjacent_y >= MAP_HEIGHT)
+        continue;
+      u32 adjacent = adjacent_x + adjacent_y * MAP_WIDTH;
+      if (state[adjacent] == FLAGGED)
+        mines--;
+      else if (state[adjacent] == UNKNOWN)
+        unknown[(*unknown_count)++] = adjacent;
+    }
+
+  return mines;
+}
+
+u32 reveal(const Board* board, u8* state, u32 cell)
+{
+  u32 stack[MAP_CELLS*8];
+  u32 stack_size = 0;
+  u32 revealed = 0;
+
+  stack[stack_size++] = cell;
+  while (stack_size)
+  {
+    cell = stack[--stack_size];
+    if (state[cell] != UNKNOWN)
+      continue;
+    state[cell] = REVEALED;
+    revealed++;
+    if (board->count[cell])
+      continue;
+
+    s32 x = cell % MAP_WIDTH;
+    s32 y = cell / MAP_WIDTH;
+    for (s32 offset_x = -1; offset_x <= 1; offset_x++)
+      for (s32 offset_y = -1; offset_y <= 1; offset_y++)
+      {
+        s32 adjacent_x = x + offset_x;
+        s32 adjacent_y = y + offset_y;
+        if (0 <= adjacent_x && adjacent_x < MAP_WIDTH && 0 <= adjacent_y && adjacent_y < MAP_HEIGHT)
+        {
+          u32 adjacent = adjacent_x + adjacent_y * MAP_WIDTH;
+          if (state[adjacent] == UNKNOWN)
+            stack[stack_size++] = adjacent;
+        }
+      }
+  }
+
+  return revealed;
+}
+
+u32 solveBoard(const Board* board, s32 start_x, s32 start_y)
+{
+  u8 state[MAP_CELLS] = { UNKNOWN };
+  u32 revealed = reveal(board, state, start_x + start_y * MAP_WIDTH);
+  u32 flagged = 0;
+
+  u32 progress = true;
+  while (progress && revealed < MAP_CELLS - MINE_COUNT)
+  {
+    progress = false;
+
+    // single numbers whose mines are all flagged or all unknown
+    for (u32 cell = 0; cell < MAP_CELLS; cell++)
+    {
+      if (state[cell] != REVEALED)
+        continue;
+      u32 unknown[8], unknown_count;
+      s32 mines = unknownNeighbours(board, state, cell, unknown, &unknown_count);
+      if (unknown_count == 0)
+        continue;
+
+      if (mines == 0)
+      {
+        for (u32 i = 0; i < unknown_count; i++)
+          revealed += reveal(board, state, unknown[i]);
+        progress = true;
+      }
+      else if (mines == (s32)unknown_count)
+      {
+        for (u32 i = 0; i < unknown_count; i++)
+          state[unknown[i]] = FLAGGED;
+        flagged += unknown_count;
+        progress = true;
+      }
+    }
+    if (progress)
+      continue;
+
+    // pairs of nearby numbers where one's unknowns are a subset of the other's
+    for (u32 a = 0; a < MAP_CELLS && !progress; a++)
+    {
+      if (state[a] != REVEALED)
+        continue;
+      u32 unknown_a[8], count_a;
+      s32 mines_a = unknownNeighbours(board, state, a, unknown_a, &count_a);
+      if (count_a == 0)
+        continue;
+
+      s32 ax = a % MAP_WIDTH;
+      s32 ay = a / MAP_WIDTH;
+      for (s32 bx = ax-2; bx <= ax+2 && !progress; bx++)
+        for (s32 by = ay-2; by <= ay+2 && !progress; by++)
+        {
+          if (bx < 0 || bx >= MAP_WIDTH || by < 0 || by >= MAP_HEIGHT)
+            continue;
+          u32 b = bx + by * MAP_WIDTH;
+          if (b == a || state[b] != REVEALED)
+            continue;
+          u32 unknown_b[8], count_b;
+          s32 mines_b = unknownNeighbours(board, state, b, unknown_b, &count_b);
+          if (count_b <= count_a)
+            continue;
+
+          u32 difference[8], difference_count = 0, shared = 0;
+          for (u32 i = 0; i < count_b; i++)
+          {
+            u32 in_a = false;
+            for (u32 u = 0; u < count_a; u++)
+              in_a |= unknown_a[u] == unknown_b[i];
+            if (in_a)
+              shared++;
+            else
+              difference[difference_count++] = unknown_b[i];
+          }
+          if (shared != count_a)
+            continue;
+
+          if (mines_b == mines_a)
+          {
+            for (u32 i = 0; i < difference_count; i++)
+              revealed += reveal(board, state, difference[i]);
+            progress = true;
+          }
+          else if (mines_b - mines_a == (s32)difference_count)
+          {
+            for (u32 i = 0; i < difference_count; i++)
+              state[difference[i]] = FLAGGED;
+            flagged += difference_count;
+            progress = true;
+          }
+        }
+    }
+    if (progress)
+      continue;
+
+    // the mine count settles whatever is left over
+    u32 unknown_total = MAP_CELLS - revealed - flagged;
+    if (flagged == MINE_COUNT || MINE_COUNT - flagged == unknown_total)
+      return true;
+  }
+
+  return revealed == MAP_CELLS - MINE_COUNT;
+}
+
+u32 pickSeedList()
+{
+  u64 uncovered[START_WORDS] = { 0 };
+  for (u32 start = 0; start < START_COUNT; start++)
+    uncovered[start / 64] |= 1ull << (start % 64);
+
+  for (u32 count = 0; count < SEED_LIST_SIZE; count++)
+  {
+    u32 best_seed = 0, best_covered = 0;
+    for (u32 seed = 0; seed < seed_limit; seed++)
+    {
+      u32 covered = 0;
+      for (u32 i = 0; i < START_WORDS; i++)
+        covered += __builtin_popcountll(seed_starts[seed][i] & uncovered[i]);
+      if (covered > best_covered)
+      {
+        best_seed = seed;
+        best_covered = covered;
+      }
+    }
+
+    seed_list[count] = best_seed;
+    for (u32 start = 0; start < START_COUNT; start++)
+      if (seed_starts[best_seed][start / 64] & uncovered[start / 64] & 1ull << (start % 64))
+        start_indices[start] = count;
+
+    u32 remaining = false;
+    for (u32 i = 0; i < START_WORDS; i++)
+    {
+      uncovered[i] &= ~seed_starts[best_seed][i];
+      remaining |= uncovered[i] != 0;
+    }
+    if (!remaining)
+      return count + 1;
+  }
+
+  return 0;
+}
+
+void runPass(const char* name)
+{
+  struct timespec start_time, end_time;
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+  u32 task_count = START_COUNT * seed_limit;
+  for (u32 i = 0; i < worker_count; i++)
+  {
+    pthread_mutex_init(&workers[i].lock, NULL);
+    workers[i].begin = (u64)task_count * i / worker_count;
+    workers[i].end = (u64)task_count * (i+1) / worker_count;
+    workers[i].boards = 0;
+    workers[i].solvable = 0;
+    workers[i].skipped = 0;
+  }
+  for (u32 i = 0; i < worker_count; i++)
+    pthread_create(&workers[i].thread, NULL, workerMain, &workers[i]);
+  for (u32 i = 0; i < worker_count; i++)
+    pthread_join(workers[i].thread, NULL);
+
+  clock_gettime(CLOCK_MONOTONIC, &end_time);
+  double seconds = (end_time.tv_sec - start_time.tv_sec) +
+    (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+
+  u64 total_boards = 0, total_solvable = 0, total_skipped = 0;
+  for (u32 i = 0; i < worker_count; i++)
+  {
+    fprintf(stderr, "%s worker %u: %llu boards checked, %llu solvable, %llu skipped\n",
+      name, i, (unsigned long long)workers[i].boards,
+      (unsigned long long)workers[i].solvable, (unsigned long long)workers[i].skipped);
+    total_boards += workers[i].boards;
+    total_solvable += workers[i].solvable;
+    total_skipped += workers[i].skipped;
+  }
+  fprintf(stderr, "%s: %llu boards checked in %.3fs on %u threads, %.0f boards/s, "
+    "%llu solvable, %llu skipped\n", name, (unsigned long long)total_boards, seconds,
+    worker_count, total_boards / seconds, (unsigned long long)total_solvable,
+    (unsigned long long)total_skipped);
+}
+
+u32 takeTask(Worker* self, u32* task)
+{
+  pthread_mutex_lock(&self->lock);
+  if (self->begin < self->end)
+  {
+    *task = self->begin++;
+    pthread_mutex_unlock(&self->lock);
+    return true;
+  }
+  pthread_mutex_unlock(&self->lock);
+
+  u32 index = self - workers;
+  for (u32 i = 1; i < worker_count; i++)
+  {
+    Worker* victim = &workers[(index + i) % worker_count];
+    pthread_mutex_lock(&victim->lock);
+    u32 remaining = victim->end - victim->begin;
+    u32 stolen_begin = victim->end - (remaining + 1) / 2;
+    u32 stolen_end = victim->end;
+    if (remaining)
+      victim->end = stolen_begin;
+    pthread_mutex_unlock(&victim->lock);
+    if (!remaining)
+      continue;
+
+    pthread_mutex_lock(&self->lock);
+    self->begin = stolen_begin + 1;
+    self->end = stolen_end;
+    pthread_mutex_unlock(&self->lock);
+    *task = stolen_begin;
+    return true;
+  }
+
+  return false;
+}
+
+void* workerMain(void* argument)
+{
+  Worker* self = argument;
+  Board board;
+  u32 task;
+
+  while (takeTask(self, &task))
+  {
+    u32 start = task / seed_limit;
+    u32 seed = task % seed_limit;
+    s32 start_x = start % START_WIDTH;
+    s32 start_y = start / START_WIDTH;
+
+    u32 best = __atomic_load_n(&start_seeds[start], __ATOMIC_RELAXED);
+    if (!covering && seed > best)
+    {
+      self->skipped++;
+      continue;
+    }
+
+    generateBoard(&board, seed, start_x, start_y);
+    self->boards++;
+    if (!solveBoard(&board, start_x, start_y))
+      continue;
+    self->solvable++;
+
+    if (covering)
+      __atomic_fetch_or(&seed_starts[seed][start / 64], 1ull << (start % 64), __ATOMIC_RELAXED);
+    else
+      while (seed < best && !__atomic_compare_exchange_n(&start_seeds[start], &best, seed,
+          false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  }
+
+  return NULL;
+}